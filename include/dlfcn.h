@@ -25,6 +25,8 @@ void  *dlopen(const char *, int);
 void  *dlsym(void *__restrict, const char *__restrict);
 
 #if defined(_GNU_SOURCE) || defined(_BSD_SOURCE)
+#define RTLD_UNLOADABLE 0x10000
+
 typedef struct {
 	const char *dli_fname;
 	void *dli_fbase;
@@ -35,6 +37,27 @@ int dladdr(const void *, Dl_info *);
 int dlinfo(void *, int, void *);
 #endif
 
+#ifdef _GNU_SOURCE
+#include <bits/dlfcn.h>
+struct link_map;
+struct dl_find_object {
+	unsigned long long dlfo_flags;
+	void *dlfo_map_start;
+	void *dlfo_map_end;
+	struct link_map *dlfo_link_map;
+	void *dlfo_eh_frame;
+#if DLFO_STRUCT_HAS_EH_DBASE
+	void *dlfo_eh_dbase;
+#endif
+#if DLFO_STRUCT_HAS_EH_COUNT
+	int dlfo_eh_count;
+	unsigned __dlfo_eh_count_pad;
+#endif
+	unsigned long long __dlfo_reserved[7];
+};
+int _dl_find_object(void *, struct dl_find_object *);
+#endif
+
 #if _REDIR_TIME64
 __REDIR(dlsym, __dlsym_time64);
 #endif
@@ -58,6 +58,11 @@ struct td_index {
 	struct td_index *next;
 };
 
+struct addr_range {
+	size_t start, len;
+	struct dso *dso;
+};
+
 struct dso {
 #if DL_FDPIC
 	struct fdpic_loadmap *loadmap;
@@ -88,6 +93,7 @@ struct dso {
 	char mark;
 	char bfs_built;
 	char runtime_loaded;
+	char unloading;
 	struct dso **deps, *needed_by;
 	size_t ndeps_direct;
 	size_t next_dep;
@@ -100,7 +106,11 @@ struct dso {
 	unsigned char *new_tls;
 	struct td_index *td_index;
 	struct dso *fini_next;
+	struct dso *unload_root, *unload_next;
+	size_t nrefs, load_seq;
 	char *shortname;
+	Sym **addr_syms;
+	size_t addr_syms_cnt;
 #if DL_FDPIC
 	unsigned char *base;
 #else
@@ -134,12 +144,16 @@ static size_t *saved_addends, *apply_addends_to;
 static struct dso ldso;
 static struct dso *head, *tail, *fini_head, *syms_tail, *lazy_head;
 static char *env_path, *sys_path;
-static unsigned long long gencnt;
+static unsigned long long gencnt, subcnt;
 static int runtime;
 static int ldd_mode;
 static int ldso_fail;
 static int noload;
 static int shutting_down;
+static volatile int iter_cnt[2], unload_pending;
+static int iter_epoch;
+static size_t load_cnt;
+static struct dso *reap_new, *reap_old;
 static jmp_buf *rtld_fail;
 static pthread_rwlock_t lock;
 static struct debug debug;
@@ -154,6 +168,8 @@ static struct dso *builtin_ctor_queue[4];
 static struct dso **main_ctor_queue;
 static struct fdpic_loadmap *app_loadmap;
 static struct fdpic_dummy_loadmap app_dummy_loadmap;
+static struct addr_range *addr_ranges;
+static size_t addr_ranges_cnt;
 
 struct debug *_dl_debug_addr = &debug;
 
@@ -1110,6 +1126,7 @@ static struct dso *load_library(const char *name, struct dso *needed_by)
 	} else {
 		/* Search for the name to see if it's already loaded */
 		for (p=head->next; p; p=p->next) {
+			if (p->unloading) continue;
 			if (p->shortname && !strcmp(p->shortname, name)) {
 				return p;
 			}
@@ -1170,6 +1187,7 @@ static struct dso *load_library(const char *name, struct dso *needed_by)
 		return 0;
 	}
 	for (p=head->next; p; p=p->next) {
+		if (p->unloading) continue;
 		if (p->dev == st.st_dev && p->ino == st.st_ino) {
 			/* If this library was previously loaded with a
 			 * pathname but a search found the same inode,
@@ -1247,6 +1265,10 @@ static struct dso *load_library(const char *name, struct dso *needed_by)
 		tls_tail = &p->tls;
 	}
 
+	/* dl_iterate_phdr walks the list without the lock and stops at
+	 * the first DSO loaded after it started. */
+	p->load_seq = ++load_cnt;
+	a_barrier();
 	tail->next = p;
 	p->prev = tail;
 	tail = p;
@@ -1466,10 +1488,24 @@ static void kernel_mapped_dso(struct dso *p)
 	p->kernel_mapped = 1;
 }
 
+static void do_fini(struct dso *p)
+{
+	size_t dyn[DYN_CNT];
+	decode_vec(p->dynv, dyn, DYN_CNT);
+	if (dyn[0] & (1<<DT_FINI_ARRAY)) {
+		size_t n = dyn[DT_FINI_ARRAYSZ]/sizeof(size_t);
+		size_t *fn = (size_t *)laddr(p, dyn[DT_FINI_ARRAY])+n;
+		while (n--) ((void (*)(void))*--fn)();
+	}
+#ifndef NO_LEGACY_INITFINI
+	if ((dyn[0] & (1<<DT_FINI)) && dyn[DT_FINI])
+		fpaddr(p, dyn[DT_FINI])();
+#endif
+}
+
 void __libc_exit_fini()
 {
 	struct dso *p;
-	size_t dyn[DYN_CNT];
 	pthread_t self = __pthread_self();
 
 	/* Take both locks before setting shutting_down, so that
@@ -1483,16 +1519,7 @@ void __libc_exit_fini()
 		while (p->ctor_visitor && p->ctor_visitor!=self)
 			pthread_cond_wait(&ctor_cond, &init_fini_lock);
 		if (!p->constructed) continue;
-		decode_vec(p->dynv, dyn, DYN_CNT);
-		if (dyn[0] & (1<<DT_FINI_ARRAY)) {
-			size_t n = dyn[DT_FINI_ARRAYSZ]/sizeof(size_t);
-			size_t *fn = (size_t *)laddr(p, dyn[DT_FINI_ARRAY])+n;
-			while (n--) ((void (*)(void))*--fn)();
-		}
-#ifndef NO_LEGACY_INITFINI
-		if ((dyn[0] & (1<<DT_FINI)) && dyn[DT_FINI])
-			fpaddr(p, dyn[DT_FINI])();
-#endif
+		do_fini(p);
 	}
 }
 
@@ -1696,6 +1723,73 @@ static void install_new_tls(void)
 	__restore_sigs(&set);
 }
 
+static int addr_range_cmp(const void *a, const void *b)
+{
+	const struct addr_range *x = a, *y = b;
+	return x->start < y->start ? -1 : x->start > y->start;
+}
+
+/* Rebuild the table of all loaded segments sorted by address, so that
+ * addr2dso does not need to walk every DSO. Called whenever the list
+ * changes, with the lock held for writing, so lookups only read it; if
+ * allocation fails the table is dropped and the linear search used. */
+static void index_addr_ranges(void)
+{
+	struct dso *p;
+	struct addr_range *r;
+	size_t cnt = 0, phcnt;
+	Phdr *ph;
+
+	for (p=head; p; p=p->next)
+		for (ph=p->phdr, phcnt=p->phnum; phcnt--; ph=(void *)((char *)ph+p->phentsize))
+			if (ph->p_type == PT_LOAD) cnt++;
+	free(addr_ranges);
+	addr_ranges = r = malloc((cnt+1) * sizeof *r);
+	if (!r) return;
+	cnt = 0;
+	for (p=head; p; p=p->next)
+		for (ph=p->phdr, phcnt=p->phnum; phcnt--; ph=(void *)((char *)ph+p->phentsize))
+			if (ph->p_type == PT_LOAD) r[cnt++] = (struct addr_range){
+				.start = (size_t)p->base + ph->p_vaddr,
+				.len = ph->p_memsz,
+				.dso = p };
+	qsort(r, cnt, sizeof *r, addr_range_cmp);
+	addr_ranges_cnt = cnt;
+}
+
+static int addr_sym_cmp(const void *a, const void *b)
+{
+	const Sym *x = *(const Sym **)a, *y = *(const Sym **)b;
+	if (x->st_value != y->st_value)
+		return x->st_value < y->st_value ? -1 : 1;
+	return x < y ? -1 : x > y;
+}
+
+/* Sort the symbols dladdr can return by address, keeping symbol table
+ * order between symbols at the same address. Done by dlopen for the
+ * libraries it loads; dladdr scans the symbols of the others. */
+static void index_addr_syms(struct dso *p)
+{
+	Sym *sym = p->syms, **list;
+	size_t nsym = count_syms(p), cnt, i;
+
+	for (i=cnt=0; i<nsym; i++)
+		if (sym[i].st_value
+		 && (1<<(sym[i].st_info&0xf) & OK_TYPES)
+		 && (1<<(sym[i].st_info>>4) & OK_BINDS))
+			cnt++;
+	list = malloc((cnt+1) * sizeof *list);
+	if (!list) return;
+	for (i=cnt=0; i<nsym; i++)
+		if (sym[i].st_value
+		 && (1<<(sym[i].st_info&0xf) & OK_TYPES)
+		 && (1<<(sym[i].st_info>>4) & OK_BINDS))
+			list[cnt++] = sym+i;
+	qsort(list, cnt, sizeof *list, addr_sym_cmp);
+	p->addr_syms_cnt = cnt;
+	p->addr_syms = list;
+}
+
 /* Stage 1 of the dynamic linker is defined in dlstart.c. It calls the
  * following stage 2 and stage 3 functions via primitive symbolic lookup
  * since it does not have access to their addresses to begin with. */
@@ -2061,6 +2155,8 @@ void __dls3(size_t *sp, size_t *auxv)
 	 * error. */
 	runtime = 1;
 
+	if (!DL_FDPIC) index_addr_ranges();
+
 	debug.ver = 1;
 	debug.bp = dl_debug_state;
 	debug.head = head;
@@ -2098,9 +2194,77 @@ static void prepare_lazy(struct dso *p)
 	lazy_head = p;
 }
 
+/* Libraries newly loaded by a dlopen with RTLD_UNLOADABLE form a group
+ * owned by the library opened, which dlclose can unmap once all the
+ * references to it are dropped. Libraries with TLS are kept, since
+ * their module ids and static TLS space are never reused. */
+static void make_group(struct dso *p)
+{
+	struct dso *q;
+	if (p == &ldso) return;
+	for (q=p; q; q=q->next)
+		if (q->tls_id) return;
+	for (q=p; q; q=q->next)
+		if (q!=&ldso) q->unload_root = p;
+	p->nrefs = 1;
+}
+
+/* Any other use of a member, through RTLD_GLOBAL or as a dependency
+ * of another library, makes its whole group permanent. */
+static void pin_group(struct dso *root)
+{
+	struct dso *q;
+	for (q=head; q; q=q->next)
+		if (q->unload_root == root) q->unload_root = 0;
+}
+
+static void free_dso(struct dso *p)
+{
+	while (p->td_index) {
+		void *tmp = p->td_index->next;
+		free(p->td_index);
+		p->td_index = tmp;
+	}
+	free(p->funcdescs);
+	if (p->rpath != p->rpath_orig)
+		free(p->rpath);
+	free(p->deps);
+	free(p->addr_syms);
+	free(p->lazy);
+	unmap_library(p);
+	free(p);
+}
+
+/* Unmap and free the libraries unlinked by dlclose or a failed dlopen
+ * once no dl_iterate_phdr walk can still be inside them. Walks count
+ * themselves in iter_cnt[iter_epoch]. Libraries unlinked since the
+ * epoch last changed wait on reap_new; the epoch only changes once the
+ * walks counted under the other one are done, so those moved to
+ * reap_old then wait just for the walks that were already running.
+ * Continuous overlapping walks thus cannot defer reaping indefinitely.
+ * Called with the lock held for writing. */
+static void reap_unloaded(void)
+{
+	struct dso *p, *next;
+
+	while (!iter_cnt[iter_epoch^1]) {
+		for (p=reap_old; p; p=next) {
+			next = p->unload_next;
+			free_dso(p);
+		}
+		reap_old = reap_new;
+		reap_new = 0;
+		if (!reap_old) {
+			unload_pending = 0;
+			return;
+		}
+		iter_epoch ^= 1;
+	}
+}
+
 void *dlopen(const char *file, int mode)
 {
-	struct dso *volatile p, *orig_tail, *orig_syms_tail, *orig_lazy_head, *next;
+	struct dso *volatile p, *orig_tail, *orig_syms_tail, *orig_lazy_head, *next, *q;
 	struct tls_module *orig_tls_tail;
 	size_t orig_tls_cnt, orig_tls_offset, orig_tls_align;
 	size_t i;
@@ -2137,17 +2301,8 @@ void *dlopen(const char *file, int mode)
 		revert_syms(orig_syms_tail);
 		for (p=orig_tail->next; p; p=next) {
 			next = p->next;
-			while (p->td_index) {
-				void *tmp = p->td_index->next;
-				free(p->td_index);
-				p->td_index = tmp;
-			}
-			free(p->funcdescs);
-			if (p->rpath != p->rpath_orig)
-				free(p->rpath);
-			free(p->deps);
-			unmap_library(p);
-			free(p);
+			p->unload_next = reap_new;
+			reap_new = p;
 		}
 		free(ctor_queue);
 		ctor_queue = 0;
@@ -2160,6 +2315,10 @@ void *dlopen(const char *file, int mode)
 		lazy_head = orig_lazy_head;
 		tail = orig_tail;
 		tail->next = 0;
+		if (reap_new) {
+			a_store(&unload_pending, 1);
+			reap_unloaded();
+		}
 		p = 0;
 		goto end;
 	} else p = load_library(file, head);
@@ -2210,6 +2369,25 @@ void *dlopen(const char *file, int mode)
 	update_tls_size();
 	if (tls_cnt != orig_tls_cnt)
 		install_new_tls();
+
+	if (mode & (RTLD_GLOBAL|RTLD_NODELETE)) {
+		if (p->unload_root) pin_group(p->unload_root);
+	} else if (p->unload_root == p) {
+		p->nrefs++;
+	} else if (p->unload_root) {
+		pin_group(p->unload_root);
+	} else if ((mode & RTLD_UNLOADABLE) && orig_tail->next == p) {
+		make_group(p);
+	}
+	for (i=0; p->deps[i]; i++)
+		if (p->deps[i]->unload_root
+		 && p->deps[i]->unload_root != p->unload_root)
+			pin_group(p->deps[i]->unload_root);
+	if (!DL_FDPIC && orig_tail != tail) {
+		for (q=orig_tail->next; q; q=q->next)
+			index_addr_syms(q);
+		index_addr_ranges();
+	}
 	orig_tail = tail;
 end:
 	debug.state = RT_CONSISTENT;
@@ -2228,15 +2406,116 @@ end:
 hidden int __dl_invalid_handle(void *h)
 {
 	struct dso *p;
-	for (p=head; p; p=p->next) if (h==p) return 0;
+	for (p=head; p; p=p->next) if (h==p && !p->unloading) return 0;
 	error("Invalid library handle %p", (void *)h);
 	return 1;
 }
 
+int dlclose(void *h)
+{
+	struct dso *p = h, *q, *fini, **fini_tail = &fini, **pp;
+	pthread_t self = __pthread_self();
+	int cs;
+
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cs);
+	pthread_rwlock_wrlock(&lock);
+	if (__dl_invalid_handle(p)) {
+		pthread_rwlock_unlock(&lock);
+		pthread_setcancelstate(cs, 0);
+		return 1;
+	}
+	if (p->unload_root != p || --p->nrefs || shutting_down) {
+		pthread_rwlock_unlock(&lock);
+		pthread_setcancelstate(cs, 0);
+		return 0;
+	}
+	p->unload_next = 0;
+	for (q=head; q; q=q->next) if (q->unload_root == p) {
+		q->unloading = 1;
+		if (q != p) {
+			q->unload_next = p->unload_next;
+			p->unload_next = q;
+		}
+	}
+	for (pp=&lazy_head; *pp; )
+		if ((*pp)->unloading) *pp = (*pp)->lazy_next;
+		else pp = &(*pp)->lazy_next;
+	pthread_rwlock_unlock(&lock);
+
+	/* Take the group off the fini list, keeping its order. */
+	pthread_mutex_lock(&init_fini_lock);
+	for (pp=&fini_head; *pp; ) {
+		q = *pp;
+		if (q->unload_root != p) {
+			pp = &q->fini_next;
+			continue;
+		}
+		if (q->ctor_visitor && q->ctor_visitor!=self) {
+			pthread_cond_wait(&ctor_cond, &init_fini_lock);
+			pp = &fini_head;
+			continue;
+		}
+		*pp = q->fini_next;
+		*fini_tail = q;
+		fini_tail = &q->fini_next;
+	}
+	*fini_tail = 0;
+	pthread_mutex_unlock(&init_fini_lock);
+
+	for (q=p; q; q=q->unload_next)
+		__funcs_on_unload(q->map, q->map_len);
+	for (; fini; fini=q) {
+		q = fini->fini_next;
+		if (fini->constructed) do_fini(fini);
+	}
+	for (q=p; q; q=q->unload_next) {
+		__at_quick_exit_unload(q->map, q->map_len);
+		__pthread_atfork_unload(q->map, q->map_len);
+	}
+
+	pthread_rwlock_wrlock(&lock);
+	debug.state = RT_DELETE;
+	_dl_debug_state();
+	for (q=p; ; q=q->unload_next) {
+		/* Walks already in progress may be at q, so its own next
+		 * link is kept until it is reaped. */
+		q->unloading = 2;
+		q->prev->next = q->next;
+		if (q->next) q->next->prev = q->prev;
+		else tail = q->prev;
+		gencnt++;
+		subcnt++;
+		if (!q->unload_next) break;
+	}
+	q->unload_next = reap_new;
+	reap_new = p;
+	if (!DL_FDPIC) index_addr_ranges();
+	debug.state = RT_CONSISTENT;
+	_dl_debug_state();
+	/* Pairs with the decrement in dl_iterate_phdr: the store must be
+	 * visible before iter_cnt is read, or both sides may skip reaping. */
+	a_store(&unload_pending, 1);
+	reap_unloaded();
+	pthread_rwlock_unlock(&lock);
+	pthread_setcancelstate(cs, 0);
+	return 0;
+}
+
 static void *addr2dso(size_t a)
 {
 	struct dso *p;
 	size_t i;
+	if (!DL_FDPIC && addr_ranges) {
+		size_t lo = 0, hi = addr_ranges_cnt, mid;
+		while (lo < hi) {
+			mid = lo + (hi-lo)/2;
+			if (addr_ranges[mid].start <= a) lo = mid+1;
+			else hi = mid;
+		}
+		if (lo && a-addr_ranges[lo-1].start < addr_ranges[lo-1].len)
+			return addr_ranges[lo-1].dso;
+		return 0;
+	}
 	if (DL_FDPIC) for (p=head; p; p=p->next) {
 		i = count_syms(p);
 		if (a-(size_t)p->funcdescs < i*sizeof(*p->funcdescs))
@@ -2303,14 +2582,35 @@ int dladdr(const void *addr_arg, Dl_info *info)
 
 	pthread_rwlock_rdlock(&lock);
 	p = addr2dso(addr);
-	pthread_rwlock_unlock(&lock);
-
-	if (!p) return 0;
+	if (!p) {
+		pthread_rwlock_unlock(&lock);
+		return 0;
+	}
 
 	sym = p->syms;
 	strings = p->strings;
 	nsym = count_syms(p);
 
+	if (p->addr_syms) {
+		Sym **list = p->addr_syms;
+		size_t lo = 0, hi = p->addr_syms_cnt, mid;
+		size_t a = addr - (size_t)p->base;
+		while (lo < hi) {
+			mid = lo + (hi-lo)/2;
+			if (list[mid]->st_value <= a) lo = mid+1;
+			else hi = mid;
+		}
+		/* among several symbols at the same address, the first one
+		 * in the symbol table is reported */
+		while (lo > 1 && list[lo-2]->st_value == list[lo-1]->st_value)
+			lo--;
+		if (lo) {
+			bestsym = list[lo-1];
+			best = (size_t)laddr(p, bestsym->st_value);
+			besterr = addr - best;
+		}
+	}
+
 	if (DL_FDPIC) {
 		size_t idx = (addr-(size_t)p->funcdescs)
 			/ sizeof(*p->funcdescs);
@@ -2321,7 +2621,7 @@ int dladdr(const void *addr_arg, Dl_info *info)
 		}
 	}
 
-	if (!best) for (; nsym; nsym--, sym++) {
+	if (!best && !p->addr_syms) for (; nsym; nsym--, sym++) {
 		if (sym->st_value
 		 && (1<<(sym->st_info&0xf) & OK_TYPES)
 		 && (1<<(sym->st_info>>4) & OK_BINDS)) {
@@ -2347,6 +2647,7 @@ int dladdr(const void *addr_arg, Dl_info *info)
 	if (!best) {
 		info->dli_sname = 0;
 		info->dli_saddr = 0;
+		pthread_rwlock_unlock(&lock);
 		return 1;
 	}
 
@@ -2355,6 +2656,7 @@ int dladdr(const void *addr_arg, Dl_info *info)
 	info->dli_sname = strings + bestsym->st_name;
 	info->dli_saddr = (void *)best;
 
+	pthread_rwlock_unlock(&lock);
 	return 1;
 }
 
@@ -2394,18 +2696,68 @@ no_redir:
 	return __dlsym(p, s, ra);
 }
 
+int _dl_find_object(void *pc, struct dl_find_object *res)
+{
+	struct dso *p;
+	Phdr *ph;
+	size_t cnt;
+
+	pthread_rwlock_rdlock(&lock);
+	p = addr2dso((size_t)pc);
+	if (!p) {
+		pthread_rwlock_unlock(&lock);
+		return -1;
+	}
+	res->dlfo_flags = 0;
+	res->dlfo_map_start = p->map;
+	res->dlfo_map_end = p->map + p->map_len;
+	res->dlfo_link_map = (void *)p;
+	res->dlfo_eh_frame = 0;
+#if DLFO_STRUCT_HAS_EH_COUNT
+	res->dlfo_eh_count = 0;
+#endif
+	for (ph=p->phdr, cnt=p->phnum; cnt--; ph=(void *)((char *)ph+p->phentsize))
+		if (ph->p_type == DLFO_EH_SEGMENT_TYPE) {
+			res->dlfo_eh_frame = laddr(p, ph->p_vaddr);
+#if DLFO_STRUCT_HAS_EH_COUNT
+			/* EHABI index entries are two words each */
+			res->dlfo_eh_count = ph->p_memsz / 8;
+#endif
+		}
+#if DLFO_STRUCT_HAS_EH_DBASE
+	res->dlfo_eh_dbase = search_vec(p->dynv, &cnt, DT_PLTGOT)
+		? laddr(p, cnt) : 0;
+#endif
+	pthread_rwlock_unlock(&lock);
+	return 0;
+}
+
 int dl_iterate_phdr(int(*callback)(struct dl_phdr_info *info, size_t size, void *data), void *data)
 {
 	struct dso *current;
 	struct dl_phdr_info info;
-	int ret = 0;
-	for(current = head; current;) {
+	unsigned long long adds, subs;
+	size_t seq;
+	int ret = 0, epoch;
+
+	/* DSOs loaded so far are committed and, while counted in iter_cnt,
+	 * this walk holds off freeing any that dlclose unlinks, so one
+	 * snapshot suffices and the walk itself needs no locking. */
+	pthread_rwlock_rdlock(&lock);
+	epoch = iter_epoch;
+	a_inc(&iter_cnt[epoch]);
+	seq = load_cnt;
+	adds = gencnt - subcnt;
+	subs = subcnt;
+	pthread_rwlock_unlock(&lock);
+
+	for(current = head; current && current->load_seq <= seq; current = current->next) {
 		info.dlpi_addr      = (uintptr_t)current->base;
 		info.dlpi_name      = current->name;
 		info.dlpi_phdr      = current->phdr;
 		info.dlpi_phnum     = current->phnum;
-		info.dlpi_adds      = gencnt;
-		info.dlpi_subs      = 0;
+		info.dlpi_adds      = adds;
+		info.dlpi_subs      = subs;
 		info.dlpi_tls_modid = current->tls_id;
 		info.dlpi_tls_data = !current->tls_id ? 0 :
 			__tls_get_addr((tls_mod_off_t[]){current->tls_id,0});
@@ -2413,9 +2765,10 @@ int dl_iterate_phdr(int(*callback)(struct dl_phdr_info *info, size_t size, void
 		ret = (callback)(&info, sizeof (info), data);
 
 		if (ret != 0) break;
-
-		pthread_rwlock_rdlock(&lock);
-		current = current->next;
+	}
+	if (a_fetch_add(&iter_cnt[epoch], -1) == 1 && unload_pending) {
+		pthread_rwlock_wrlock(&lock);
+		reap_unloaded();
 		pthread_rwlock_unlock(&lock);
 	}
 	return ret;
@@ -66,7 +66,7 @@ static double __frexp_exp(double x, int *expt)
  */
 double complex __ldexp_cexp(double complex z, int expt)
 {
-	double x, y, exp_x, scale1, scale2;
+	double x, y, exp_x, scale1, scale2, s, c;
 	int ex_expt, half_expt;
 
 	x = creal(z);
@@ -83,5 +83,6 @@ double complex __ldexp_cexp(double complex z, int expt)
 	half_expt = expt - half_expt;
 	INSERT_WORDS(scale2, (0x3ff + half_expt) << 20, 0);
 
-	return CMPLX(cos(y) * exp_x * scale1 * scale2, sin(y) * exp_x * scale1 * scale2);
+	__sincos(y, &s, &c);
+	return CMPLX(c * exp_x * scale1 * scale2, s * exp_x * scale1 * scale2);
 }
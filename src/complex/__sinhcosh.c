@@ -0,0 +1,38 @@
+#include "complex_impl.h"
+
+/*
+ * Compute sinh(x) and cosh(x) with a single call to expm1, using the
+ * same formulas as sinh and cosh.  Only valid for finite |x| < 22,
+ * the range the complex hyperbolic functions need it for.
+ */
+void __sinhcosh(double x, double *sh, double *ch)
+{
+	double t, h, absx;
+	uint32_t w;
+
+	h = signbit(x) ? -0.5 : 0.5;
+	absx = fabs(x);
+	GET_HIGH_WORD(w, absx);
+
+	/* note: inexact and underflow are raised by expm1 */
+	t = expm1(absx);
+	if (w < 0x3ff00000 - (26<<20)) {
+		*sh = x;
+		*ch = 1;
+		return;
+	}
+
+	/* sinh(x) = (exp(x)-1 + (exp(x)-1)/exp(x))/2 */
+	if (w < 0x3ff00000)
+		*sh = h*(2*t - t*t/(t+1));
+	else
+		*sh = h*(t + t/(t+1));
+
+	/* cosh(x) = 1 + 0.5*(exp(x)-1)*(exp(x)-1)/exp(x) */
+	if (w < 0x3fe62e42) {
+		*ch = 1 + t*t/(2*(1+t));
+	} else {
+		/* avoid rounding exp(x) = t+1 before the sum */
+		*ch = 0.5*t + (0.5 + 0.5/(t+1));
+	}
+}
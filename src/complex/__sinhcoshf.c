@@ -0,0 +1,30 @@
+#include "complex_impl.h"
+
+/* see __sinhcosh.c, only valid for finite |x| < 9 */
+void __sinhcoshf(float x, float *sh, float *ch)
+{
+	float t, h, absx;
+	uint32_t w;
+
+	h = signbit(x) ? -0.5f : 0.5f;
+	absx = fabsf(x);
+	GET_FLOAT_WORD(w, absx);
+
+	t = expm1f(absx);
+	if (w < 0x3f800000 - (12<<23)) {
+		*sh = x;
+		*ch = 1;
+		return;
+	}
+
+	if (w < 0x3f800000)
+		*sh = h*(2*t - t*t/(t+1));
+	else
+		*sh = h*(t + t/(t+1));
+
+	if (w < 0x3f317217) {
+		*ch = 1 + t*t/(2*(1+t));
+	} else {
+		*ch = 0.5f*t + (0.5f + 0.5f/(t+1));
+	}
+}
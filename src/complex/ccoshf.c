@@ -34,7 +34,7 @@ static const float huge = 0x1p127;
 
 float complex ccoshf(float complex z)
 {
-	float x, y, h;
+	float x, y, h, sh, ch, s, c;
 	int32_t hx, hy, ix, iy;
 
 	x = crealf(z);
@@ -49,14 +49,18 @@ float complex ccoshf(float complex z)
 	if (ix < 0x7f800000 && iy < 0x7f800000) {
 		if (iy == 0)
 			return CMPLXF(coshf(x), x * y);
-		if (ix < 0x41100000)    /* small x: normal case */
-			return CMPLXF(coshf(x) * cosf(y), sinhf(x) * sinf(y));
+		if (ix < 0x41100000) {  /* small x: normal case */
+			__sinhcoshf(x, &sh, &ch);
+			__sincosf(y, &s, &c);
+			return CMPLXF(ch * c, sh * s);
+		}
 
 		/* |x| >= 9, so cosh(x) ~= exp(|x|) */
 		if (ix < 0x42b17218) {
 			/* x < 88.7: expf(|x|) won't overflow */
 			h = expf(fabsf(x)) * 0.5f;
-			return CMPLXF(h * cosf(y), copysignf(h, x) * sinf(y));
+			__sincosf(y, &s, &c);
+			return CMPLXF(h * c, copysignf(h, x) * s);
 		} else if (ix < 0x4340b1e7) {
 			/* x < 192.7: scale to avoid overflow */
 			z = __ldexp_cexpf(CMPLXF(fabsf(x), y), -1);
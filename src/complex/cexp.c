@@ -33,7 +33,7 @@ cexp_ovfl = 0x4096b8e4;  /* (MAX_EXP - MIN_DENORM_EXP) * ln2 */
 
 double complex cexp(double complex z)
 {
-	double x, y, exp_x;
+	double x, y, exp_x, s, c;
 	uint32_t hx, hy, lx, ly;
 
 	x = creal(z);
@@ -47,8 +47,10 @@ double complex cexp(double complex z)
 		return CMPLX(exp(x), y);
 	EXTRACT_WORDS(hx, lx, x);
 	/* cexp(0 + I y) = cos(y) + I sin(y) */
-	if (((hx & 0x7fffffff) | lx) == 0)
-		return CMPLX(cos(y), sin(y));
+	if (((hx & 0x7fffffff) | lx) == 0) {
+		__sincos(y, &s, &c);
+		return CMPLX(c, s);
+	}
 
 	if (hy >= 0x7ff00000) {
 		if (lx != 0 || (hx & 0x7fffffff) != 0x7ff00000) {
@@ -78,6 +80,7 @@ double complex cexp(double complex z)
 		 *  -  x = NaN (spurious inexact exception from y)
 		 */
 		exp_x = exp(x);
-		return CMPLX(exp_x * cos(y), exp_x * sin(y));
+		__sincos(y, &s, &c);
+		return CMPLX(exp_x * c, exp_x * s);
 	}
 }
@@ -33,7 +33,7 @@ cexp_ovfl = 0x43400074;  /* (MAX_EXP - MIN_DENORM_EXP) * ln2 */
 
 float complex cexpf(float complex z)
 {
-	float x, y, exp_x;
+	float x, y, exp_x, s, c;
 	uint32_t hx, hy;
 
 	x = crealf(z);
@@ -47,8 +47,10 @@ float complex cexpf(float complex z)
 		return CMPLXF(expf(x), y);
 	GET_FLOAT_WORD(hx, x);
 	/* cexp(0 + I y) = cos(y) + I sin(y) */
-	if ((hx & 0x7fffffff) == 0)
-		return CMPLXF(cosf(y), sinf(y));
+	if ((hx & 0x7fffffff) == 0) {
+		__sincosf(y, &s, &c);
+		return CMPLXF(c, s);
+	}
 
 	if (hy >= 0x7f800000) {
 		if ((hx & 0x7fffffff) != 0x7f800000) {
@@ -78,6 +80,7 @@ float complex cexpf(float complex z)
 		 *  -  x = NaN (spurious inexact exception from y)
 		 */
 		exp_x = expf(x);
-		return CMPLXF(exp_x * cosf(y), exp_x * sinf(y));
+		__sincosf(y, &s, &c);
+		return CMPLXF(exp_x * c, exp_x * s);
 	}
 }
@@ -40,7 +40,7 @@ static const double huge = 0x1p1023;
 
 double complex csinh(double complex z)
 {
-	double x, y, h;
+	double x, y, h, sh, ch, s, c;
 	int32_t hx, hy, ix, iy, lx, ly;
 
 	x = creal(z);
@@ -56,14 +56,18 @@ double complex csinh(double complex z)
 	if (ix < 0x7ff00000 && iy < 0x7ff00000) {
 		if ((iy | ly) == 0)
 			return CMPLX(sinh(x), y);
-		if (ix < 0x40360000)    /* small x: normal case */
-			return CMPLX(sinh(x) * cos(y), cosh(x) * sin(y));
+		if (ix < 0x40360000) {  /* small x: normal case */
+			__sinhcosh(x, &sh, &ch);
+			__sincos(y, &s, &c);
+			return CMPLX(sh * c, ch * s);
+		}
 
 		/* |x| >= 22, so cosh(x) ~= exp(|x|) */
 		if (ix < 0x40862e42) {
 			/* x < 710: exp(|x|) won't overflow */
 			h = exp(fabs(x)) * 0.5;
-			return CMPLX(copysign(h, x) * cos(y), h * sin(y));
+			__sincos(y, &s, &c);
+			return CMPLX(copysign(h, x) * c, h * s);
 		} else if (ix < 0x4096bbaa) {
 			/* x < 1455: scale to avoid overflow */
 			z = __ldexp_cexp(CMPLX(fabs(x), y), -1);
@@ -5,8 +5,11 @@
 #include <signal.h>
 #include <sys/sysinfo.h>
 #include <sys/auxv.h>
+#include <fcntl.h>
+#include <string.h>
 #include "syscall.h"
 #include "libc.h"
+#include "atomic.h"
 
 #define JT(x) (-256|(x))
 #define VER JT(1)
@@ -22,9 +25,71 @@
 #define JT_DELAYTIMER_MAX JT(11)
 #define JT_MINSIGSTKSZ JT(12)
 #define JT_SIGSTKSZ JT(13)
+#define JT_CACHE JT(14)
 
 #define RLIM(x) (-32768|(RLIMIT_ ## x))
 
+static long sysfs_num(char *path, size_t l, const char *file, char *type)
+{
+	char buf[32];
+	long v = 0;
+	int fd, i, n;
+	strcpy(path+l, file);
+	fd = sys_open(path, O_RDONLY|O_CLOEXEC);
+	if (fd < 0) return -1;
+	n = __syscall(SYS_read, fd, buf, sizeof buf - 1);
+	__syscall(SYS_close, fd);
+	if (n <= 0) return -1;
+	buf[n] = 0;
+	if (type) *type = buf[0];
+	for (i=0; buf[i]-'0' < 10U; i++) v = 10*v + buf[i]-'0';
+	if (buf[i]=='K') v <<= 10;
+	if (buf[i]=='M') v <<= 20;
+	return v;
+}
+
+#define CACHE_DIR "/sys/devices/system/cpu/cpu0/cache/index0/"
+
+/* Cache geometry is read once from the kernel's cacheinfo for cpu0,
+ * as size, associativity and line size for L1I, L1D, L2, L3 and L4,
+ * in the order of the _SC_LEVEL* names. Missing values are 0. If the
+ * cacheinfo cannot be read at all, e.g. before /sys is mounted, 0 is
+ * returned without caching it, so a later call tries again. */
+
+static long cache_info(int name)
+{
+	static long info[15];
+	static volatile int init;
+	char path[sizeof CACHE_DIR + 24] = CACHE_DIR;
+	size_t l = sizeof CACHE_DIR - 1;
+	long tmp[15] = { 0 };
+	char type = 0;
+	int i;
+
+	if (init) {
+		a_barrier();
+		return info[name - _SC_LEVEL1_ICACHE_SIZE];
+	}
+	for (i=0; i<10; i++) {
+		path[l-2] = '0'+i;
+		long level = sysfs_num(path, l, "level", 0);
+		if (level < 0) break;
+		type = 0;
+		sysfs_num(path, l, "type", &type);
+		if (level < 1 || level > 4 || (level > 1 && type == 'I'))
+			continue;
+		long *p = tmp + 3*level - (level==1 && type=='I') * 3;
+		p[0] = sysfs_num(path, l, "size", 0);
+		p[1] = sysfs_num(path, l, "ways_of_associativity", 0);
+		p[2] = sysfs_num(path, l, "coherency_line_size", 0);
+	}
+	if (!i) return 0;
+	for (i=0; i<15; i++) info[i] = tmp[i] < 0 ? 0 : tmp[i];
+	a_barrier();
+	init = 1;
+	return info[name - _SC_LEVEL1_ICACHE_SIZE];
+}
+
 long sysconf(int name)
 {
 	static const short values[] = {
@@ -153,6 +218,21 @@ long sysconf(int name)
 		[_SC_TRACE_EVENT_FILTER] = -1,
 		[_SC_TRACE_INHERIT] = -1,
 		[_SC_TRACE_LOG] = -1,
+		[_SC_LEVEL1_ICACHE_SIZE] = JT_CACHE,
+		[_SC_LEVEL1_ICACHE_ASSOC] = JT_CACHE,
+		[_SC_LEVEL1_ICACHE_LINESIZE] = JT_CACHE,
+		[_SC_LEVEL1_DCACHE_SIZE] = JT_CACHE,
+		[_SC_LEVEL1_DCACHE_ASSOC] = JT_CACHE,
+		[_SC_LEVEL1_DCACHE_LINESIZE] = JT_CACHE,
+		[_SC_LEVEL2_CACHE_SIZE] = JT_CACHE,
+		[_SC_LEVEL2_CACHE_ASSOC] = JT_CACHE,
+		[_SC_LEVEL2_CACHE_LINESIZE] = JT_CACHE,
+		[_SC_LEVEL3_CACHE_SIZE] = JT_CACHE,
+		[_SC_LEVEL3_CACHE_ASSOC] = JT_CACHE,
+		[_SC_LEVEL3_CACHE_LINESIZE] = JT_CACHE,
+		[_SC_LEVEL4_CACHE_SIZE] = JT_CACHE,
+		[_SC_LEVEL4_CACHE_ASSOC] = JT_CACHE,
+		[_SC_LEVEL4_CACHE_LINESIZE] = JT_CACHE,
 
 		[_SC_IPV6] = VER,
 		[_SC_RAW_SOCKETS] = VER,
@@ -202,9 +282,10 @@ long sysconf(int name)
 	case JT_NPROCESSORS_CONF & 255:
 	case JT_NPROCESSORS_ONLN & 255: ;
 		unsigned char set[128] = {1};
-		int i, cnt;
-		__syscall(SYS_sched_getaffinity, 0, sizeof set, set);
-		for (i=cnt=0; i<sizeof set; i++)
+		int i, cnt, n;
+		n = __syscall(SYS_sched_getaffinity, 0, sizeof set, set);
+		if (n <= 0) n = sizeof set;
+		for (i=cnt=0; i<n; i++)
 			for (; set[i]; set[i]&=set[i]-1, cnt++);
 		return cnt;
 	case JT_PHYS_PAGES & 255:
@@ -227,6 +308,8 @@ long sysconf(int name)
 		return val;
 	case JT_ZERO & 255:
 		return 0;
+	case JT_CACHE & 255:
+		return cache_info(name);
 	}
 	return values[name];
 }
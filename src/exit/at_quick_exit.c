@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdint.h>
 #include "libc.h"
 #include "lock.h"
 #include "fork_impl.h"
@@ -22,6 +23,19 @@ void __funcs_on_quick_exit()
 	}
 }
 
+/* Drop the handlers lying in [start, start+len), which is about to be
+ * unmapped by dlclose. */
+void __at_quick_exit_unload(void *start, size_t len)
+{
+	int i, j;
+	LOCK(lock);
+	for (i=j=0; i<count; i++)
+		if ((uintptr_t)funcs[i]-(uintptr_t)start >= len)
+			funcs[j++] = funcs[i];
+	count = j;
+	UNLOCK(lock);
+}
+
 int at_quick_exit(void (*func)(void))
 {
 	int r = 0;
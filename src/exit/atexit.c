@@ -17,9 +17,10 @@ static struct fl
 	struct fl *next;
 	void (*f[COUNT])(void *);
 	void *a[COUNT];
+	void *d[COUNT];
 } builtin, *head;
 
-static int slot;
+static int slot, exited;
 static volatile int lock[1];
 volatile int *const __atexit_lockptr = lock;
 
@@ -30,14 +31,53 @@ void __funcs_on_exit()
 	for (; head; head=head->next, slot=COUNT) while(slot-->0) {
 		func = head->f[slot];
 		arg = head->a[slot];
+		if (!func) continue;
 		UNLOCK(lock);
 		func(arg);
 		LOCK(lock);
 	}
+	/* The lock stays held; every handler has now been run, so the
+	 * finalizers that follow must not try to take it again. */
+	exited = 1;
+}
+
+/* Run, newest first, the handlers registered for dso, or whose function,
+ * argument or dso handle lies in [start, start+len), and clear their
+ * slots. Checking the argument catches functions passed to atexit. */
+static void finalize(void *dso, uintptr_t start, size_t len)
+{
+	struct fl *fl;
+	void (*func)(void *), *arg;
+	int i;
+
+	if (exited) return;
+	LOCK(lock);
+again:
+	for (fl=head, i=slot; fl; fl=fl->next, i=COUNT) while (i-->0) {
+		func = fl->f[i];
+		if (!func) continue;
+		arg = fl->a[i];
+		if (dso ? fl->d[i] != dso : (uintptr_t)func-start >= len
+		    && (uintptr_t)arg-start >= len
+		    && (uintptr_t)fl->d[i]-start >= len)
+			continue;
+		fl->f[i] = 0;
+		UNLOCK(lock);
+		func(arg);
+		LOCK(lock);
+		goto again;
+	}
+	UNLOCK(lock);
 }
 
 void __cxa_finalize(void *dso)
 {
+	if (dso) finalize(dso, 0, 0);
+}
+
+void __funcs_on_unload(void *start, size_t len)
+{
+	finalize(0, (uintptr_t)start, len);
 }
 
 int __cxa_atexit(void (*func)(void *), void *arg, void *dso)
@@ -62,6 +102,7 @@ int __cxa_atexit(void (*func)(void *), void *arg, void *dso)
 	/* Append function to the list. */
 	head->f[slot] = func;
 	head->a[slot] = arg;
+	head->d[slot] = dso;
 	slot++;
 
 	UNLOCK(lock);
@@ -36,16 +36,24 @@ __fesetround:
 	push %rax
 	xor %eax,%eax
 	mov %edi,%ecx
+		# only load control words whose rounding mode changes,
+		# fldcw and ldmxcsr are much slower than the stores
 	fnstcw (%esp)
+	mov (%esp),%dx
 	andb $0xf3,1(%esp)
 	or %ch,1(%esp)
+	cmp (%esp),%dx
+	je 1f
 	fldcw (%esp)
-	stmxcsr (%esp)
+1:	stmxcsr (%esp)
+	mov (%esp),%edx
 	shl $3,%ch
 	andb $0x9f,1(%esp)
 	or %ch,1(%esp)
+	cmp (%esp),%edx
+	je 1f
 	ldmxcsr (%esp)
-	pop %rcx
+1:	pop %rcx
 	ret
 
 .global fegetround
@@ -36,16 +36,24 @@ __fesetround:
 	push %rax
 	xor %eax,%eax
 	mov %edi,%ecx
+		# only load control words whose rounding mode changes,
+		# fldcw and ldmxcsr are much slower than the stores
 	fnstcw (%rsp)
+	mov (%rsp),%dx
 	andb $0xf3,1(%rsp)
 	or %ch,1(%rsp)
+	cmp (%rsp),%dx
+	je 1f
 	fldcw (%rsp)
-	stmxcsr (%rsp)
+1:	stmxcsr (%rsp)
+	mov (%rsp),%edx
 	shl $3,%ch
 	andb $0x9f,1(%rsp)
 	or %ch,1(%rsp)
+	cmp (%rsp),%edx
+	je 1f
 	ldmxcsr (%rsp)
-	pop %rcx
+1:	pop %rcx
 	ret
 
 .global fegetround
@@ -3,6 +3,7 @@
 
 #include "../../include/string.h"
 
+hidden void *__memmem(const void *, size_t, const void *, size_t);
 hidden void *__memrchr(const void *, int, size_t);
 hidden char *__stpcpy(char *, const char *);
 hidden char *__stpncpy(char *, const char *, size_t);
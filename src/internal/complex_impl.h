@@ -19,4 +19,7 @@
 hidden double complex __ldexp_cexp(double complex,int);
 hidden float complex __ldexp_cexpf(float complex,int);
 
+hidden void __sinhcosh(double,double*,double*);
+hidden void __sinhcoshf(float,float*,float*);
+
 #endif
@@ -4,6 +4,7 @@ extern hidden volatile int *const __at_quick_exit_lockptr;
 extern hidden volatile int *const __atexit_lockptr;
 extern hidden volatile int *const __gettext_lockptr;
 extern hidden volatile int *const __locale_lockptr;
+extern hidden volatile int *const __mq_notify_lockptr;
 extern hidden volatile int *const __random_lockptr;
 extern hidden volatile int *const __sem_open_lockptr;
 extern hidden volatile int *const __stdio_ofl_lockptr;
@@ -17,5 +18,6 @@ extern hidden volatile int *const __vmlock_lockptr;
 hidden void __malloc_atfork(int);
 hidden void __ldso_atfork(int);
 hidden void __pthread_key_atfork(int);
+hidden void __mq_notify_atfork(int);
 
 hidden void __post_Fork(int);
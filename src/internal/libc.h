@@ -42,9 +42,12 @@ hidden void __init_tls(size_t *);
 hidden void __init_ssp(void *);
 hidden void __libc_start_init(void);
 hidden void __funcs_on_exit(void);
+hidden void __funcs_on_unload(void *, size_t);
 hidden void __funcs_on_quick_exit(void);
+hidden void __at_quick_exit_unload(void *, size_t);
 hidden void __libc_exit_fini(void);
 hidden void __fork_handler(int);
+hidden void __pthread_atfork_unload(void *, size_t);
 
 extern hidden size_t __hwcap;
 extern hidden size_t __sysinfo;
@@ -0,0 +1,63 @@
+#define _GNU_SOURCE
+#include <elf.h>
+#include <link.h>
+#include <dlfcn.h>
+#include "libc.h"
+
+#define AUX_CNT 38
+
+extern weak hidden const size_t _DYNAMIC[];
+
+static int static_dl_find_object(void *pc, struct dl_find_object *res)
+{
+	unsigned char *p;
+	ElfW(Phdr) *phdr;
+	size_t base = 0, start = -1, end = 0, eh_frame = 0, eh_len = 0;
+	size_t n, i, aux[AUX_CNT] = {0};
+	int found = 0;
+
+	for (i=0; libc.auxv[i]; i+=2)
+		if (libc.auxv[i]<AUX_CNT) aux[libc.auxv[i]] = libc.auxv[i+1];
+
+	for (p=(void *)aux[AT_PHDR],n=aux[AT_PHNUM]; n; n--,p+=aux[AT_PHENT]) {
+		phdr = (void *)p;
+		if (phdr->p_type == PT_PHDR)
+			base = aux[AT_PHDR] - phdr->p_vaddr;
+		if (phdr->p_type == PT_DYNAMIC && _DYNAMIC)
+			base = (size_t)_DYNAMIC - phdr->p_vaddr;
+	}
+	for (p=(void *)aux[AT_PHDR],n=aux[AT_PHNUM]; n; n--,p+=aux[AT_PHENT]) {
+		phdr = (void *)p;
+		if (phdr->p_type == DLFO_EH_SEGMENT_TYPE) {
+			eh_frame = base + phdr->p_vaddr;
+			eh_len = phdr->p_memsz;
+		}
+		if (phdr->p_type != PT_LOAD) continue;
+		if ((size_t)pc - base - phdr->p_vaddr < phdr->p_memsz)
+			found = 1;
+		if (phdr->p_vaddr < start)
+			start = phdr->p_vaddr;
+		if (phdr->p_vaddr + phdr->p_memsz > end)
+			end = phdr->p_vaddr + phdr->p_memsz;
+	}
+	if (!found) return -1;
+
+	res->dlfo_flags = 0;
+	res->dlfo_map_start = (void *)(base + start);
+	res->dlfo_map_end = (void *)(base + end);
+	res->dlfo_link_map = 0;
+	res->dlfo_eh_frame = (void *)eh_frame;
+#if DLFO_STRUCT_HAS_EH_COUNT
+	/* EHABI index entries are two words each */
+	res->dlfo_eh_count = eh_len / 8;
+#endif
+#if DLFO_STRUCT_HAS_EH_DBASE
+	res->dlfo_eh_dbase = 0;
+	if (_DYNAMIC) for (i=0; _DYNAMIC[i]; i+=2)
+		if (_DYNAMIC[i] == DT_PLTGOT)
+			res->dlfo_eh_dbase = (void *)(base + _DYNAMIC[i+1]);
+#endif
+	return 0;
+}
+
+weak_alias(static_dl_find_object, _dl_find_object);
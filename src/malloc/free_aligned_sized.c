@@ -0,0 +1,6 @@
+#include <stdlib.h>
+
+void free_aligned_sized(void *p, size_t a, size_t n)
+{
+	free(p);
+}
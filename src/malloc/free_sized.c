@@ -0,0 +1,6 @@
+#include <stdlib.h>
+
+void free_sized(void *p, size_t n)
+{
+	free(p);
+}
@@ -7,6 +7,7 @@
 #include "lock.h"
 #include "syscall.h"
 #include "fork_impl.h"
+#include "atomic.h"
 
 #define ALIGN 16
 
@@ -35,9 +36,34 @@ static int traverses_stack_p(uintptr_t old, uintptr_t new)
 static volatile int lock[1];
 volatile int *const __bump_lockptr = lock;
 
+static volatile uintptr_t cur, end;
+
+/* Allocation from the current area is lock-free: it only advances
+ * cur by compare-and-swap. The area is changed, under the lock, by
+ * first setting cur to a value above any end so that stale bumps
+ * fail, then publishing the new end, then the new cur. Extending the
+ * brk area only moves end up, which is safe for concurrent bumps. */
+
+static void *bump(size_t n, size_t align)
+{
+	uintptr_t c, e, p;
+	do {
+		c = cur;
+		a_barrier();
+		e = end;
+		p = c + (-c & align-1);
+		if (c > e || p > e || n > e-p) return 0;
+		if (!libc.need_locks) {
+			cur = p+n;
+			break;
+		}
+	} while (a_cas_p(&cur, (void *)c, (void *)(p+n)) != (void *)c);
+	return (void *)p;
+}
+
 static void *__simple_malloc(size_t n)
 {
-	static uintptr_t brk, cur, end;
+	static uintptr_t brk;
 	static unsigned mmap_step;
 	size_t align=1;
 	void *p;
@@ -51,23 +77,25 @@ static void *__simple_malloc(size_t n)
 	while (align<n && align<ALIGN)
 		align += align;
 
-	LOCK(lock);
+	if ((p = bump(n, align))) return p;
 
-	cur += -cur & align-1;
+	LOCK(lock);
 
-	if (n > end-cur) {
-		size_t req = n - (end-cur) + PAGE_SIZE-1 & -PAGE_SIZE;
+	if (!cur) {
+		brk = __syscall(SYS_brk, 0);
+		brk += -brk & PAGE_SIZE-1;
+		cur = end = brk;
+	}
 
-		if (!cur) {
-			brk = __syscall(SYS_brk, 0);
-			brk += -brk & PAGE_SIZE-1;
-			cur = end = brk;
-		}
+	while (!(p = bump(n, align))) {
+		uintptr_t c = cur, e = end;
+		c += -c & align-1;
+		size_t req = c + n - e + PAGE_SIZE-1 & -PAGE_SIZE;
 
-		if (brk == end && req < SIZE_MAX-brk
+		if (brk == e && req < SIZE_MAX-brk
 		    && !traverses_stack_p(brk, brk+req)
 		    && __syscall(SYS_brk, brk+req)==brk+req) {
-			brk = end += req;
+			brk = end = e + req;
 		} else {
 			int new_area = 0;
 			req = n + PAGE_SIZE-1 & -PAGE_SIZE;
@@ -77,7 +105,7 @@ static void *__simple_malloc(size_t n)
 				/* Geometric area size growth up to 64 pages,
 				 * bounding waste by 1/8 of the area. */
 				size_t min = PAGE_SIZE<<(mmap_step/2);
-				if (min-n > end-cur) {
+				if (c > e || min-n > e-c) {
 					if (req < min) {
 						req = min;
 						if (mmap_step < 12)
@@ -92,13 +120,16 @@ static void *__simple_malloc(size_t n)
 				UNLOCK(lock);
 				return mem==MAP_FAILED ? 0 : mem;
 			}
-			cur = (uintptr_t)mem;
-			end = cur + req;
+			cur = -1;
+			a_barrier();
+			end = (uintptr_t)mem + req;
+			a_barrier();
+			cur = (uintptr_t)mem + n;
+			p = mem;
+			break;
 		}
 	}
 
-	p = (void *)cur;
-	cur += n;
 	UNLOCK(lock);
 	return p;
 }
@@ -88,6 +88,9 @@ static struct mapinfo nontrivial_free(struct meta *g, int i)
 		return free_group(g);
 	} else if (!mask) {
 		assert(sc < 48);
+		// a retained single-slot map is no longer known to be
+		// zero-filled; see is_allzero.
+		if (!g->last_idx) g->mem->dirty = 1;
 		// might still be active if there were no allocations
 		// after last available slot was taken.
 		if (ctx.active[sc] != g) {
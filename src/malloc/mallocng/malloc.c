@@ -383,5 +383,6 @@ int is_allzero(void *p)
 {
 	struct meta *g = get_meta(p);
 	return g->sizeclass >= 48 ||
-		get_stride(g) < UNIT*size_classes[g->sizeclass];
+		get_stride(g) < UNIT*size_classes[g->sizeclass] ||
+		!g->last_idx && g->maplen && !g->mem->dirty;
 }
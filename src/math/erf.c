@@ -76,11 +76,15 @@
  *              S2(z) = degree 7 poly in z
  *
  *      Note1:
- *         To compute exp(-x*x-0.5625+R/S), let s be a single
- *         precision number and s := x; then
- *              -x*x = -s*s + (s-x)*(s+x)
- *              exp(-x*x-0.5626+R/S) =
- *                      exp(-s*s-0.5625)*exp((s-x)*(s+x)+R/S);
+ *         To compute exp(-x*x-0.5625+R/S), let s be x with the low
+ *         32 bits cleared; then s*s is exact and
+ *              -x*x-0.5625+R/S = hi + lo,
+ *              hi = -s*s-0.5625 (exact), lo = (s-x)*(s+x)+R/S
+ *         with |lo| < 1 < |hi|.  Let t = hi+lo rounded and
+ *         e = (hi-t)+lo its exact rounding error, then
+ *              exp(-x*x-0.5625+R/S) = exp(t)*(1+e)
+ *         to within the accuracy of exp, which needs only one
+ *         call to exp.
  *      Note2:
  *         Here 4 and 5 make use of the asymptotic series
  *                        exp(-x*x)
@@ -187,6 +191,7 @@ static double erfc1(double x)
 static double erfc2(uint32_t ix, double x)
 {
 	double_t s,R,S;
+	double hi,lo,t;
 	double z;
 
 	if (ix < 0x3ff40000)  /* |x| < 1.25 */
@@ -205,9 +210,15 @@ static double erfc2(uint32_t ix, double x)
 		S = 1.0+s*(sb1+s*(sb2+s*(sb3+s*(sb4+s*(
 		     sb5+s*(sb6+s*sb7))))));
 	}
+	/* see Note1 */
 	z = x;
 	SET_LOW_WORD(z,0);
-	return exp(-z*z-0.5625)*exp((z-x)*(z+x)+R/S)/x;
+	hi = -z*z-0.5625;
+	lo = (z-x)*(z+x)+R/S;
+	t = hi + lo;
+	lo = hi - t + lo;
+	t = exp(t);
+	return (t + t*lo)/x;
 }
 
 double erf(double x)
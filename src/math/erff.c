@@ -97,7 +97,6 @@ static float erfc1(float x)
 static float erfc2(uint32_t ix, float x)
 {
 	float_t s,R,S;
-	float z;
 
 	if (ix < 0x3fa00000)  /* |x| < 1.25 */
 		return erfc1(x);
@@ -115,9 +114,8 @@ static float erfc2(uint32_t ix, float x)
 		S = 1.0f+s*(sb1+s*(sb2+s*(sb3+s*(sb4+s*(
 		     sb5+s*(sb6+s*sb7))))));
 	}
-	GET_FLOAT_WORD(ix, x);
-	SET_FLOAT_WORD(z, ix&0xffffe000);
-	return expf(-z*z - 0.5625f) * expf((z-x)*(z+x) + R/S)/x;
+	/* x*x is exact in double precision, so a single exp call is enough */
+	return exp(-(double)x*x - 0.5625 + R/S)/x;
 }
 
 float erff(float x)
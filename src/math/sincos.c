@@ -13,7 +13,7 @@
 #define _GNU_SOURCE
 #include "libm.h"
 
-void sincos(double x, double *sin, double *cos)
+void __sincos(double x, double *sin, double *cos)
 {
 	double y[2], s, c;
 	uint32_t ix;
@@ -67,3 +67,5 @@ void sincos(double x, double *sin, double *cos)
 		break;
 	}
 }
+
+weak_alias(__sincos, sincos);
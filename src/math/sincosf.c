@@ -24,7 +24,7 @@ s2pio2 = 2*M_PI_2, /* 0x400921FB, 0x54442D18 */
 s3pio2 = 3*M_PI_2, /* 0x4012D97C, 0x7F3321D2 */
 s4pio2 = 4*M_PI_2; /* 0x401921FB, 0x54442D18 */
 
-void sincosf(float x, float *sin, float *cos)
+void __sincosf(float x, float *sin, float *cos)
 {
 	double y;
 	float_t s, c;
@@ -115,3 +115,5 @@ void sincosf(float x, float *sin, float *cos)
 		break;
 	}
 }
+
+weak_alias(__sincosf, sincosf);
@@ -3,6 +3,9 @@
 #include <errno.h>
 #include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "syscall.h"
 
 static size_t slash_len(const char *s)
 {
@@ -11,6 +14,30 @@ static size_t slash_len(const char *s)
 	return s-s0;
 }
 
+/* Have the kernel resolve the whole path at once and read the result
+ * back from /proc. The result is only trusted if it names the same
+ * file, since /proc may be missing or show paths outside a chroot or
+ * with a " (deleted)" suffix. */
+
+static ssize_t proc_realpath(const char *filename, char *output)
+{
+	char buf[15+3*sizeof(int)];
+	struct stat st1, st2;
+	ssize_t k;
+	int fd = sys_open(filename, O_PATH|O_NONBLOCK|O_CLOEXEC);
+	if (fd < 0) return -1;
+	__procfdname(buf, fd);
+	k = readlink(buf, output, PATH_MAX);
+	if (k <= 0 || k == PATH_MAX || output[0] != '/'
+	    || fstat(fd, &st1)) k = -1;
+	__syscall(SYS_close, fd);
+	if (k < 0) return -1;
+	output[k] = 0;
+	if (stat(output, &st2) || st1.st_dev != st2.st_dev
+	    || st1.st_ino != st2.st_ino) return -1;
+	return k;
+}
+
 char *realpath(const char *restrict filename, char *restrict resolved)
 {
 	char stack[PATH_MAX+1];
@@ -28,6 +55,20 @@ char *realpath(const char *restrict filename, char *restrict resolved)
 		return 0;
 	}
 	if (l >= PATH_MAX) goto toolong;
+
+	/* Resolving component by component costs a readlink per prefix,
+	 * each walking the whole prefix again, so deep paths are cheaper
+	 * to resolve in one go, despite the fixed cost of verifying it.
+	 * The kernel does not preserve an initial // though. */
+	ssize_t k = -1;
+	for (p=q=0; p<l; p++) q += filename[p]=='/';
+	if (q >= 7 && (filename[0]!='/' || filename[1]!='/' || filename[2]=='/'))
+		k = proc_realpath(filename, output);
+	if (k >= 0) {
+		q = k;
+		goto done;
+	}
+
 	p = sizeof stack - l - 1;
 	q = 0;
 	memcpy(stack+p, filename, l+1);
@@ -92,7 +133,7 @@ restart:
 			 * directories, processing .. can skip readlink. */
 			if (!check_dir) goto skip_readlink;
 		}
-		ssize_t k = readlink(output, stack, p);
+		k = readlink(output, stack, p);
 		if (k==p) goto toolong;
 		if (!k) {
 			errno = ENOENT;
@@ -147,6 +188,7 @@ skip_readlink:
 		q = l + q-p;
 	}
 
+done:
 	if (resolved) return memcpy(resolved, output, q+1);
 	else return strdup(output);
 
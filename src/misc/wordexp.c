@@ -9,6 +9,8 @@
 #include <signal.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <ctype.h>
+#include <glob.h>
 #include "pthread_impl.h"
 
 static void reap(pid_t pid)
@@ -23,6 +25,189 @@ static char *getword(FILE *f)
 	return getdelim(&s, (size_t [1]){0}, 0, f) < 0 ? 0 : s;
 }
 
+/* The common subset of the shell language is expanded in-process:
+ * quoting, ~ and ~/ from $HOME, $NAME and ${NAME} for variables set
+ * in the environment, field splitting with the default IFS, and
+ * pathname expansion. Anything else, including anything the shell
+ * might evaluate differently, makes expand return -1 so the caller
+ * runs the shell instead. */
+
+struct buf {
+	char *s;
+	size_t n, a;
+};
+
+struct fields {
+	struct buf lit, pat;
+	int have, glob;
+	char **v;
+	size_t n;
+};
+
+static int bput(struct buf *b, int c)
+{
+	if (b->n+1 >= b->a) {
+		size_t a = 2*b->a + 32;
+		char *t = realloc(b->s, a);
+		if (!t) return -1;
+		b->s = t;
+		b->a = a;
+	}
+	b->s[b->n++] = c;
+	b->s[b->n] = 0;
+	return 0;
+}
+
+static int put(struct fields *f, int c, int quoted)
+{
+	if (quoted && strchr("*?[\\", c) && bput(&f->pat, '\\'))
+		return WRDE_NOSPACE;
+	if (!quoted && strchr("*?[", c)) f->glob = 1;
+	f->have = 1;
+	return bput(&f->lit, c) || bput(&f->pat, c) ? WRDE_NOSPACE : 0;
+}
+
+static int push(struct fields *f, char *w)
+{
+	char **v = w ? realloc(f->v, (f->n+1)*sizeof *v) : 0;
+	if (!v) {
+		free(w);
+		return WRDE_NOSPACE;
+	}
+	f->v = v;
+	f->v[f->n++] = w;
+	return 0;
+}
+
+static int end_field(struct fields *f)
+{
+	glob_t g;
+	size_t j;
+	int r = 0;
+	if (!f->have) return 0;
+	if (f->glob && !(r = glob(f->pat.s, 0, 0, &g))) {
+		for (j=0; !r && j<g.gl_pathc; j++)
+			r = push(f, strdup(g.gl_pathv[j]));
+		globfree(&g);
+	} else if (r == GLOB_NOSPACE) {
+		r = WRDE_NOSPACE;
+	} else {
+		r = push(f, f->lit.s ? f->lit.s : strdup(""));
+		f->lit = (struct buf){ 0 };
+	}
+	if (f->lit.s) f->lit.s[0] = 0;
+	if (f->pat.s) f->pat.s[0] = 0;
+	f->lit.n = f->pat.n = 0;
+	f->have = f->glob = 0;
+	return r;
+}
+
+static const char *lookup(const char *name, size_t l)
+{
+	static const char special[][9] = {
+		"IFS", "PPID", "PWD", "OPTIND", "SHLVL", "_", "LINENO",
+		"PS1", "PS2", "PS4", "RANDOM", "SECONDS", "SHELLOPTS",
+	};
+	size_t i;
+	if (l >= 4 && !memcmp(name, "BASH", 4)) return 0;
+	for (i=0; i<sizeof special/sizeof *special; i++)
+		if (l < sizeof *special && !strncmp(special[i], name, l)
+		    && !special[i][l])
+			return 0;
+	for (char **e = __environ; e && *e; e++)
+		if (!strncmp(*e, name, l) && (*e)[l]=='=')
+			return *e+l+1;
+	return 0;
+}
+
+static int param(const char **ps, struct fields *f, int quoted)
+{
+	const char *s = *ps+1, *e, *v;
+	int brace = *s=='{', r = 0;
+	s += brace;
+	if (*s=='_' || isalpha((unsigned char)*s))
+		for (e=s+1; *e=='_' || isalnum((unsigned char)*e); e++);
+	else if (brace || strchr(quoted ? "(@*#?-$!" : "(@*#?-$!'\"", *s)
+	    || isdigit((unsigned char)*s))
+		return -1;
+	else
+		return put(f, '$', quoted);
+	if (brace && *e!='}') return -1;
+	if (!(v = lookup(s, e-s))) return -1;
+	if (!quoted && strpbrk(v, "*?[\\")) return -1;
+	*ps = e - !brace;
+	for (; *v && !r; v++) {
+		if (!quoted && strchr(" \t\n", *v)) r = end_field(f);
+		else r = put(f, *v, quoted);
+	}
+	return r;
+}
+
+static int expand(const char *s, struct fields *f)
+{
+	const char *v;
+	int dq = 0, start = 1, r = 0;
+	for (; *s && !r; s++) {
+		if (dq) switch (*s) {
+		case '"':
+			dq = 0;
+			continue;
+		case '\\':
+			if (!s[1] || s[1]=='\n') return -1;
+			if (strchr("$`\"\\", s[1])) s++;
+			r = put(f, *s, 1);
+			continue;
+		case '`':
+			return -1;
+		case '$':
+			r = param(&s, f, 1);
+			continue;
+		default:
+			r = put(f, *s, 1);
+			continue;
+		}
+		if (*s==' ' || *s=='\t') {
+			r = end_field(f);
+			start = 1;
+			continue;
+		}
+		switch (*s) {
+		case '\\':
+			if (!*++s || *s=='\n') return -1;
+			r = put(f, *s, 1);
+			break;
+		case '\'':
+			f->have = 1;
+			for (s++; *s != '\''; s++) {
+				if (!*s) return -1;
+				if ((r = put(f, *s, 1))) return r;
+			}
+			break;
+		case '"':
+			f->have = dq = 1;
+			break;
+		case '$':
+			r = param(&s, f, 0);
+			break;
+		case '~':
+			if (!start) goto literal;
+			if (s[1] && !strchr("/ \t", s[1])) return -1;
+			if (!(v = lookup("HOME", 4))) return -1;
+			for (f->have = 1; *v && !r; v++) r = put(f, *v, 1);
+			break;
+		case '\n': case '|': case '&': case ';': case '<': case '>':
+		case '(': case ')': case '{': case '}': case '`': case '#':
+			return -1;
+		default:
+		literal:
+			r = put(f, *s, 0);
+		}
+		start = 0;
+	}
+	if (dq) return -1;
+	return r ? r : end_field(f);
+}
+
 static int do_wordexp(const char *s, wordexp_t *we, int flags)
 {
 	size_t i, l;
@@ -96,6 +281,23 @@ static int do_wordexp(const char *s, wordexp_t *we, int flags)
 		we->we_offs = 0;
 	}
 
+	struct fields fl = { 0 };
+	err = expand(s, &fl);
+	free(fl.lit.s);
+	free(fl.pat.s);
+	if (!err && (tmp = realloc(wv, (i+fl.n+1)*sizeof *wv))) {
+		wv = tmp;
+		memcpy(wv+i, fl.v, fl.n*sizeof *wv);
+		i += fl.n;
+		wv[i] = 0;
+		free(fl.v);
+		goto done;
+	}
+	while (fl.n) free(fl.v[--fl.n]);
+	free(fl.v);
+	if (err >= 0) goto nospace;
+	err = 0;
+
 	if (pipe2(p, O_CLOEXEC) < 0) goto nospace;
 	__block_all_sigs(&set);
 	pid = fork();
@@ -147,6 +349,7 @@ static int do_wordexp(const char *s, wordexp_t *we, int flags)
 	fclose(f);
 	reap(pid);
 
+done:
 	if (!wv) wv = calloc(i+1, sizeof *wv);
 
 	we->we_wordv = wv;
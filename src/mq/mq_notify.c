@@ -5,7 +5,12 @@
 #include <signal.h>
 #include <unistd.h>
 #include <semaphore.h>
+#include <string.h>
+#include <sys/epoll.h>
 #include "syscall.h"
+#include "atomic.h"
+#include "lock.h"
+#include "fork_impl.h"
 
 struct args {
 	sem_t sem;
@@ -43,6 +48,167 @@ static void *start(void *p)
 	return 0;
 }
 
+/* Notifications without thread attributes are delivered through a
+ * shared set of netlink sockets, multiplexed with epoll, and run on a
+ * pool of threads that survive the callbacks. The kernel sends back
+ * the cookie passed at registration, which carries the function and
+ * value, so no table of registrations is needed. Every registration
+ * ends with exactly one message, and its skb is charged to the socket
+ * receive buffer until then, so sockets are opened as needed to keep
+ * registration from blocking on a full buffer. */
+
+#define NOTIFY_COOKIE_LEN 32
+#define NOTIFY_WOKENUP 1
+#define MAX_SOCKS 64
+#define MAX_IDLE 4
+
+struct cookie {
+	void (*func)(union sigval);
+	union sigval val;
+};
+
+static volatile int lock[1];
+volatile int *const __mq_notify_lockptr = lock;
+static int pool_ep = -1, nsocks, sock_limit;
+static volatile int idle;
+static struct {
+	int fd;
+	volatile int pending;
+} socks[MAX_SOCKS];
+
+static void *worker(void *p);
+
+static int spawn(void)
+{
+	pthread_attr_t attr;
+	pthread_t td;
+	sigset_t allmask, origmask;
+	int r;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	sigfillset(&allmask);
+	a_inc(&idle);
+	pthread_sigmask(SIG_BLOCK, &allmask, &origmask);
+	r = pthread_create(&td, &attr, worker, 0);
+	pthread_sigmask(SIG_SETMASK, &origmask, 0);
+	if (r) a_dec(&idle);
+	return r;
+}
+
+static void *worker(void *p)
+{
+	struct epoll_event ev;
+	char buf[NOTIFY_COOKIE_LEN];
+	struct cookie c;
+	int i;
+
+	for (;;) {
+		if (epoll_wait(pool_ep, &ev, 1, -1) != 1) continue;
+		i = ev.data.u32;
+		if (recv(socks[i].fd, buf, sizeof buf, MSG_DONTWAIT|MSG_NOSIGNAL)
+		    != sizeof buf)
+			continue;
+		a_dec(&socks[i].pending);
+		/* Keep a thread waiting while this one runs the callback. */
+		if (a_fetch_add(&idle, -1) == 1) spawn();
+		if (buf[sizeof buf - 1] == NOTIFY_WOKENUP) {
+			memcpy(&c, buf, sizeof c);
+			c.func(c.val);
+		}
+		if (a_fetch_add(&idle, 1) >= MAX_IDLE) break;
+	}
+	a_dec(&idle);
+	return 0;
+}
+
+/* A forked child has none of the pool threads and must not share
+ * sockets with its parent, so it closes the inherited ones while their
+ * numbers are still known to be ours and starts a new pool on demand. */
+void __mq_notify_atfork(int who)
+{
+	int i;
+	if (who <= 0 || pool_ep < 0) return;
+	__syscall(SYS_close, pool_ep);
+	for (i=0; i<nsocks; i++) __syscall(SYS_close, socks[i].fd);
+	pool_ep = -1;
+	nsocks = 0;
+	idle = 0;
+}
+
+/* Returns the index of a socket with room for one more registration,
+ * setting up the pool on first use. Called with the lock held. */
+static int get_sock(void)
+{
+	int i, s;
+	struct epoll_event ev = { .events = EPOLLIN };
+
+	if (pool_ep < 0) {
+		pool_ep = epoll_create1(EPOLL_CLOEXEC);
+		if (pool_ep < 0) return -1;
+	}
+	for (i=0; i<nsocks; i++)
+		if (socks[i].pending < sock_limit) return i;
+	if (nsocks == MAX_SOCKS) return -2;
+
+	s = socket(AF_NETLINK, SOCK_RAW|SOCK_CLOEXEC, 0);
+	if (s < 0) return -1;
+	if (!sock_limit) {
+		int rcvbuf = 0;
+		socklen_t len = sizeof rcvbuf;
+		getsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &len);
+		/* Each pending skb costs well under 1k of buffer space. */
+		sock_limit = rcvbuf >= 2048 ? rcvbuf/1024 : 1;
+	}
+	ev.data.u32 = i;
+	if (epoll_ctl(pool_ep, EPOLL_CTL_ADD, s, &ev)) {
+		__syscall(SYS_close, s);
+		return -1;
+	}
+	socks[i].fd = s;
+	socks[i].pending = 0;
+	nsocks++;
+	return i;
+}
+
+static int pool_notify(mqd_t mqd, const struct sigevent *sev)
+{
+	struct sigevent sev2;
+	union {
+		char buf[NOTIFY_COOKIE_LEN];
+		struct cookie c;
+	} u = { .c = {
+		.func = sev->sigev_notify_function,
+		.val = sev->sigev_value } };
+	int i, err, need_worker;
+
+	LOCK(lock);
+	i = get_sock();
+	if (i < 0) {
+		UNLOCK(lock);
+		if (i == -2) errno = EAGAIN;
+		return -1;
+	}
+	a_inc(&socks[i].pending);
+	need_worker = !idle;
+	UNLOCK(lock);
+
+	/* Not under the lock: pthread_create takes the ptc lock, which
+	 * fork takes before the atfork locks. */
+	if (need_worker && spawn()) {
+		a_dec(&socks[i].pending);
+		errno = EAGAIN;
+		return -1;
+	}
+
+	sev2.sigev_notify = SIGEV_THREAD;
+	sev2.sigev_signo = socks[i].fd;
+	sev2.sigev_value.sival_ptr = u.buf;
+	err = __syscall(SYS_mq_notify, mqd, &sev2);
+	if (err) a_dec(&socks[i].pending);
+	return __syscall_ret(err);
+}
+
 int mq_notify(mqd_t mqd, const struct sigevent *sev)
 {
 	struct args args = { .sev = sev };
@@ -54,14 +220,15 @@ int mq_notify(mqd_t mqd, const struct sigevent *sev)
 
 	if (!sev || sev->sigev_notify != SIGEV_THREAD)
 		return syscall(SYS_mq_notify, mqd, sev);
+	if (!sev->sigev_notify_attributes)
+		return pool_notify(mqd, sev);
 
 	s = socket(AF_NETLINK, SOCK_RAW|SOCK_CLOEXEC, 0);
 	if (s < 0) return -1;
 	args.sock = s;
 	args.mqd = mqd;
 
-	if (sev->sigev_notify_attributes) attr = *sev->sigev_notify_attributes;
-	else pthread_attr_init(&attr);
+	attr = *sev->sigev_notify_attributes;
 	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 	sem_init(&args.sem, 0, 0);
 
@@ -2,6 +2,7 @@
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <unistd.h>
 #include <ifaddrs.h>
 #include <syscall.h>
@@ -38,20 +39,61 @@ struct ifaddrs_storage {
 	char name[IFNAMSIZ+1];
 };
 
+/* Entries are carved out of large blocks rather than allocated one at
+ * a time. The first entry of the list is always the first one in the
+ * first block, which lets freeifaddrs find the chain of blocks. */
+#define IFADDRS_BLOCK_SIZE 16384
+
+struct ifaddrs_block {
+	struct ifaddrs_block *next;
+	size_t used, size;
+	struct ifaddrs_storage first[];
+};
+
 struct ifaddrs_ctx {
 	struct ifaddrs *first;
 	struct ifaddrs *last;
+	struct ifaddrs_block *blocks, *cur;
 	struct ifaddrs_storage *hash[IFADDRS_HASH_SIZE];
 };
 
+static void free_blocks(struct ifaddrs_block *b)
+{
+	struct ifaddrs_block *n;
+	while (b) {
+		n = b->next;
+		free(b);
+		b = n;
+	}
+}
+
 void freeifaddrs(struct ifaddrs *ifp)
 {
-	struct ifaddrs *n;
-	while (ifp) {
-		n = ifp->ifa_next;
-		free(ifp);
-		ifp = n;
+	if (ifp) free_blocks((struct ifaddrs_block *)
+		((char *)ifp - offsetof(struct ifaddrs_block, first)));
+}
+
+static struct ifaddrs_storage *alloc_storage(struct ifaddrs_ctx *ctx, size_t size)
+{
+	struct ifaddrs_block *b = ctx->cur;
+	struct ifaddrs_storage *ifs;
+
+	size = (size + sizeof(void *)-1) & -sizeof(void *);
+	if (!b || b->size - b->used < size) {
+		size_t n = size > IFADDRS_BLOCK_SIZE ? size : IFADDRS_BLOCK_SIZE;
+		b = malloc(sizeof *b + n);
+		if (!b) return 0;
+		b->next = 0;
+		b->used = 0;
+		b->size = n;
+		if (ctx->cur) ctx->cur->next = b;
+		else ctx->blocks = b;
+		ctx->cur = b;
 	}
+	ifs = (void *)((char *)b->first + b->used);
+	b->used += size;
+	memset(ifs, 0, size);
+	return ifs;
 }
 
 static void copy_addr(struct sockaddr **r, int af, union sockany *sa, void *addr, size_t addrlen, int ifindex)
@@ -124,7 +166,7 @@ static int netlink_msg_to_ifaddr(void *pctx, struct nlmsghdr *h)
 		if (!ifs0) return 0;
 	}
 
-	ifs = calloc(1, sizeof(struct ifaddrs_storage) + stats_len);
+	ifs = alloc_storage(ctx, sizeof(struct ifaddrs_storage) + stats_len);
 	if (ifs == 0) return -1;
 
 	if (h->nlmsg_type == RTM_NEWLINK) {
@@ -199,7 +241,8 @@ static int netlink_msg_to_ifaddr(void *pctx, struct nlmsghdr *h)
 		if (ctx->last) ctx->last->ifa_next = &ifs->ifa;
 		ctx->last = &ifs->ifa;
 	} else {
-		free(ifs);
+		/* Unnamed entries are dropped; reuse the space. */
+		ctx->cur->used = (char *)ifs - (char *)ctx->cur->first;
 	}
 	return 0;
 }
@@ -210,7 +253,10 @@ int getifaddrs(struct ifaddrs **ifap)
 	int r;
 	memset(ctx, 0, sizeof *ctx);
 	r = __rtnetlink_enumerate(AF_UNSPEC, AF_UNSPEC, netlink_msg_to_ifaddr, ctx);
-	if (r == 0) *ifap = ctx->first;
-	else freeifaddrs(ctx->first);
+	if (r == 0 && ctx->first) *ifap = ctx->first;
+	else {
+		free_blocks(ctx->blocks);
+		if (r == 0) *ifap = 0;
+	}
 	return r;
 }
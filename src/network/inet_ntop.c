@@ -1,54 +1,74 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <errno.h>
-#include <stdio.h>
 #include <string.h>
 
+static char *put_dec(char *p, unsigned v)
+{
+	if (v >= 100) *p++ = '0' + v/100;
+	if (v >= 10) *p++ = '0' + v/10%10;
+	*p++ = '0' + v%10;
+	return p;
+}
+
+static char *put_hex(char *p, unsigned v)
+{
+	int k = (v>=0x1000) + (v>=0x100) + (v>=0x10);
+	for (; k>=0; k--) *p++ = "0123456789abcdef"[v>>4*k & 15];
+	return p;
+}
+
 const char *inet_ntop(int af, const void *restrict a0, char *restrict s, socklen_t l)
 {
 	const unsigned char *a = a0;
-	int i, j, max, best;
-	char buf[100];
+	int i, j, n, max, best, run;
+	char buf[INET6_ADDRSTRLEN], *p = buf;
 
 	switch (af) {
 	case AF_INET:
-		if (snprintf(s, l, "%d.%d.%d.%d", a[0],a[1],a[2],a[3]) < l)
-			return s;
+		for (i=0; i<4; i++) {
+			if (i) *p++ = '.';
+			p = put_dec(p, a[i]);
+		}
 		break;
 	case AF_INET6:
-		if (memcmp(a, "\0\0\0\0\0\0\0\0\0\0\377\377", 12))
-			snprintf(buf, sizeof buf,
-				"%x:%x:%x:%x:%x:%x:%x:%x",
-				256*a[0]+a[1],256*a[2]+a[3],
-				256*a[4]+a[5],256*a[6]+a[7],
-				256*a[8]+a[9],256*a[10]+a[11],
-				256*a[12]+a[13],256*a[14]+a[15]);
-		else
-			snprintf(buf, sizeof buf,
-				"%x:%x:%x:%x:%x:%x:%d.%d.%d.%d",
-				256*a[0]+a[1],256*a[2]+a[3],
-				256*a[4]+a[5],256*a[6]+a[7],
-				256*a[8]+a[9],256*a[10]+a[11],
-				a[12],a[13],a[14],a[15]);
-		/* Replace longest /(^0|:)[:0]{2,}/ with "::" */
-		for (i=best=0, max=2; buf[i]; i++) {
-			if (i && buf[i] != ':') continue;
-			j = strspn(buf+i, ":0");
-			if (j>max) best=i, max=j;
+		/* Mapped IPv4 addresses end in dotted-decimal form. */
+		n = memcmp(a, "\0\0\0\0\0\0\0\0\0\0\377\377", 12) ? 8 : 6;
+		/* Replace the longest /(^0|:)[:0]{2,}/ of the full form
+		 * with "::"; a run of j zero fields spans 2*j characters,
+		 * less one at the start and plus one when not at the end. */
+		for (i=0, best=-1, run=0, max=3; i<n; i+=j+1) {
+			for (j=0; i+j<n && !(a[2*(i+j)] | a[2*(i+j)+1]); j++);
+			if (j && 2*j-!i+(i+j<n) > max)
+				best=i, run=j, max=2*j-!i+(i+j<n);
 		}
-		if (max>3) {
-			buf[best] = buf[best+1] = ':';
-			memmove(buf+best+2, buf+best+max, i-best-max+1);
+		for (i=0; i<n; i++) {
+			if (i==best) {
+				*p++ = ':';
+				*p++ = ':';
+				i += run-1;
+				continue;
+			}
+			if (i && i!=best+run) *p++ = ':';
+			p = put_hex(p, 256*a[2*i]+a[2*i+1]);
 		}
-		if (strlen(buf) < l) {
-			strcpy(s, buf);
-			return s;
+		if (n==6) {
+			if (best+run!=6) *p++ = ':';
+			for (i=12; i<16; i++) {
+				if (i>12) *p++ = '.';
+				p = put_dec(p, a[i]);
+			}
 		}
 		break;
 	default:
 		errno = EAFNOSUPPORT;
 		return 0;
 	}
+	*p = 0;
+	if (p-buf < l) {
+		memcpy(s, buf, p-buf+1);
+		return s;
+	}
 	errno = ENOSPC;
 	return 0;
 }
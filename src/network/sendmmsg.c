@@ -4,25 +4,55 @@
 #include <errno.h>
 #include "syscall.h"
 
+#if LONG_MAX > INT_MAX
+static int cmsg_pads_clear(const struct msghdr *h)
+{
+	struct cmsghdr *c;
+	for (c=CMSG_FIRSTHDR(h); c; c=CMSG_NXTHDR((struct msghdr *)h,c))
+		if (c->__pad1) return 0;
+	return 1;
+}
+#endif
+
 int sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, unsigned int flags)
 {
 #if LONG_MAX > INT_MAX
-	/* Can't use the syscall directly because the kernel has the wrong
-	 * idea for the types of msg_iovlen, msg_controllen, and cmsg_len,
-	 * and the cmsg blocks cannot be modified in-place. */
-	int i;
+	/* Can't pass msgvec to the syscall directly because the kernel has
+	 * the wrong idea for the types of msg_iovlen, msg_controllen, and
+	 * cmsg_len, and the cmsg blocks cannot be modified in-place. The
+	 * headers are copied with the padding cleared and sent in batches;
+	 * messages whose cmsg padding is not clear go through sendmsg. */
+	struct mmsghdr tmp[64];
+	int i, j, n, r;
 	if (vlen > IOV_MAX) vlen = IOV_MAX; /* This matches the kernel. */
 	if (!vlen) return 0;
-	for (i=0; i<vlen; i++) {
-		/* As an unfortunate inconsistency, the sendmmsg API uses
-		 * unsigned int for the resulting msg_len, despite sendmsg
-		 * returning ssize_t. However Linux limits the total bytes
-		 * sent by sendmsg to INT_MAX, so the assignment is safe. */
-		ssize_t r = sendmsg(fd, &msgvec[i].msg_hdr, flags);
-		if (r < 0) goto error;
-		msgvec[i].msg_len = r;
+	for (i=0; i<vlen; i+=r) {
+		for (n=0; n<sizeof tmp/sizeof *tmp && i+n<vlen; n++) {
+			tmp[n].msg_hdr = msgvec[i+n].msg_hdr;
+			tmp[n].msg_hdr.__pad1 = tmp[n].msg_hdr.__pad2 = 0;
+			if (tmp[n].msg_hdr.msg_controllen
+			    && !cmsg_pads_clear(&tmp[n].msg_hdr))
+				break;
+		}
+		r = n ? __syscall_cp(SYS_sendmmsg, fd, tmp, n, flags) : -ENOSYS;
+		if (r == -ENOSYS) {
+			/* As an unfortunate inconsistency, the sendmmsg API
+			 * uses unsigned int for the resulting msg_len, despite
+			 * sendmsg returning ssize_t. However Linux limits the
+			 * total bytes sent by sendmsg to INT_MAX, so the
+			 * assignment is safe. */
+			ssize_t len = sendmsg(fd, &msgvec[i].msg_hdr, flags);
+			if (len < 0) break;
+			msgvec[i].msg_len = len;
+			r = n = 1;
+		} else if (r < 0) {
+			if (!i) return __syscall_ret(r);
+			break;
+		} else for (j=0; j<r; j++) {
+			msgvec[i+j].msg_len = tmp[j].msg_len;
+		}
+		if (r < n) return i+r;
 	}
-error:
 	return i ? i : -1;
 #else
 	return syscall_cp(SYS_sendmmsg, fd, msgvec, vlen, flags);
@@ -11,6 +11,7 @@ weak_alias(dummy_lockptr, __at_quick_exit_lockptr);
 weak_alias(dummy_lockptr, __atexit_lockptr);
 weak_alias(dummy_lockptr, __gettext_lockptr);
 weak_alias(dummy_lockptr, __locale_lockptr);
+weak_alias(dummy_lockptr, __mq_notify_lockptr);
 weak_alias(dummy_lockptr, __random_lockptr);
 weak_alias(dummy_lockptr, __sem_open_lockptr);
 weak_alias(dummy_lockptr, __stdio_ofl_lockptr);
@@ -25,6 +26,7 @@ static volatile int *const *const atfork_locks[] = {
 	&__atexit_lockptr,
 	&__gettext_lockptr,
 	&__locale_lockptr,
+	&__mq_notify_lockptr,
 	&__random_lockptr,
 	&__sem_open_lockptr,
 	&__stdio_ofl_lockptr,
@@ -39,6 +41,7 @@ weak_alias(dummy, __malloc_atfork);
 weak_alias(dummy, __aio_atfork);
 weak_alias(dummy, __pthread_key_atfork);
 weak_alias(dummy, __ldso_atfork);
+weak_alias(dummy, __mq_notify_atfork);
 
 static void dummy_0(void) { }
 weak_alias(dummy_0, __tl_lock);
@@ -83,6 +86,7 @@ pid_t fork(void)
 		__pthread_key_atfork(!ret);
 		__ldso_atfork(!ret);
 	}
+	__mq_notify_atfork(!ret);
 	__restore_sigs(&set);
 	__fork_handler(!ret);
 	if (ret<0) errno = errno_save;
@@ -11,6 +11,12 @@ FILE *tmpfile(void)
 	int fd;
 	FILE *f;
 	int try;
+	fd = sys_open("/tmp", O_RDWR|O_TMPFILE, 0600);
+	if (fd >= 0) {
+		f = __fdopen(fd, "w+");
+		if (!f) __syscall(SYS_close, fd);
+		return f;
+	}
 	for (try=0; try<MAXTRIES; try++) {
 		__randname(s+13);
 		fd = sys_open(s, O_RDWR|O_CREAT|O_EXCL, 0600);
@@ -2,19 +2,24 @@
 
 void *bsearch(const void *key, const void *base, size_t nel, size_t width, int (*cmp)(const void *, const void *))
 {
-	void *try;
-	int sign;
-	while (nel > 0) {
-		try = (char *)base + width*(nel/2);
-		sign = cmp(key, try);
-		if (sign < 0) {
-			nel /= 2;
-		} else if (sign > 0) {
-			base = (char *)try + width;
-			nel -= nel/2+1;
-		} else {
-			return try;
-		}
+	const char *try;
+	size_t half;
+
+	if (!nel) return NULL;
+
+	/* Narrow the range to a single candidate without an early exit,
+	 * so the outcome of cmp only selects the next base and does not
+	 * need to be predicted.  Both possible next probes are prefetched
+	 * to keep large tables from stalling on every step. */
+	while (nel > 1) {
+		half = nel/2;
+		try = (char *)base + width*half;
+		nel -= half;
+#ifdef __GNUC__
+		__builtin_prefetch((char *)base + width*(nel/2));
+		__builtin_prefetch(try + width*(nel/2));
+#endif
+		if (cmp(key, try) >= 0) base = try;
 	}
-	return NULL;
+	return cmp(key, base) ? NULL : (void *)base;
 }
@@ -1,6 +1,8 @@
 #define _GNU_SOURCE
 #include <string.h>
 #include <stdint.h>
+#include <limits.h>
+#include <endian.h>
 
 static char *twobyte_memmem(const unsigned char *h, size_t k, const unsigned char *n)
 {
@@ -126,7 +128,59 @@ static char *twoway_memmem(const unsigned char *h, const unsigned char *z, const
 	}
 }
 
-void *memmem(const void *h0, size_t k, const void *n0, size_t l)
+#define SS (sizeof(size_t))
+#define ALIGN (sizeof(size_t)-1)
+#define ONES ((size_t)-1/UCHAR_MAX)
+#define HIGHS (ONES * (UCHAR_MAX/2+1))
+#define HASZERO(x) ((x)-ONES & ~(x) & HIGHS)
+
+/* Only positions whose bytes match the first and the last byte of the
+ * needle can start a match; find them a word at a time and compare the
+ * rest directly. The bytes spent in failed compares are charged
+ * against a budget proportional to the bytes scanned; once it is
+ * exceeded the search continues with Two-Way, keeping it linear. */
+static char *filter_memmem(const unsigned char *h, const unsigned char *z, const unsigned char *n, size_t l)
+{
+	const unsigned char *h0 = h;
+	size_t i, d = l-1, cost = 0;
+
+#ifdef __GNUC__
+	typedef size_t __attribute__((__may_alias__)) word;
+	const word *w;
+	size_t a, b, k0 = ONES*n[0], k1 = ONES*n[d], r = d & ALIGN;
+	for (; (uintptr_t)h & ALIGN && z-h >= l; h++) {
+		if (h[0] != n[0] || h[d] != n[d]) continue;
+		if (!memcmp(h+1, n+1, l-2)) return (char *)h;
+		cost += l;
+	}
+	for (; z-h >= l+2*SS; h+=SS) {
+		a = *(const word *)h ^ k0;
+		w = (const word *)(h+d-r);
+		if (!r) b = w[0];
+		else if (__BYTE_ORDER == __LITTLE_ENDIAN)
+			b = w[0] >> 8*r | w[1] << 8*(SS-r);
+		else
+			b = w[0] << 8*r | w[1] >> 8*(SS-r);
+		b ^= k1;
+		if (!(HASZERO(a) & HASZERO(b))) continue;
+		for (i=0; i<SS; i++) {
+			if (h[i] != n[0] || h[i+d] != n[d]) continue;
+			if (!memcmp(h+i+1, n+1, l-2)) return (char *)h+i;
+			if ((cost += l) > 1024 + 2*(h+i-h0))
+				return twoway_memmem(h+i, z, n, l);
+		}
+	}
+#endif
+	for (; z-h >= l; h++) {
+		if (h[0] != n[0] || h[d] != n[d]) continue;
+		if (!memcmp(h+1, n+1, l-2)) return (char *)h;
+		if ((cost += l) > 1024 + 2*(h-h0))
+			return twoway_memmem(h, z, n, l);
+	}
+	return 0;
+}
+
+void *__memmem(const void *h0, size_t k, const void *n0, size_t l)
 {
 	const unsigned char *h = h0, *n = n0;
 
@@ -145,5 +199,7 @@ void *memmem(const void *h0, size_t k, const void *n0, size_t l)
 	if (l==3) return threebyte_memmem(h, k, n);
 	if (l==4) return fourbyte_memmem(h, k, n);
 
-	return twoway_memmem(h, h+k, n, l);
+	return filter_memmem(h, h+k, n, l);
 }
+
+weak_alias(__memmem, memmem);
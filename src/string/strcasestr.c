@@ -1,9 +1,15 @@
 #define _GNU_SOURCE
 #include <string.h>
+#include <ctype.h>
 
 char *strcasestr(const char *h, const char *n)
 {
 	size_t l = strlen(n);
-	for (; *h; h++) if (!strncasecmp(h, n, l)) return (char *)h;
+	int c = tolower(*(unsigned char *)n);
+	if (!l) return (char *)h;
+	for (; *h; h++)
+		if (tolower(*(unsigned char *)h) == c
+		 && !strncasecmp(h+1, n+1, l-1))
+			return (char *)h;
 	return 0;
 }
@@ -1,8 +1,15 @@
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 
 #define BITOP(a,b,op) \
  ((a)[(size_t)(b)/(8*sizeof *(a))] op (size_t)1<<((size_t)(b)%(8*sizeof *(a))))
 
+#define ALIGN (sizeof(size_t))
+#define ONES ((size_t)-1/UCHAR_MAX)
+#define HIGHS (ONES * (UCHAR_MAX/2+1))
+#define HASZERO(x) ((x)-ONES & ~(x) & HIGHS)
+
 size_t strcspn(const char *s, const char *c)
 {
 	const char *a = s;
@@ -10,6 +17,28 @@ size_t strcspn(const char *s, const char *c)
 
 	if (!c[0] || !c[1]) return __strchrnul(s, *c)-a;
 
+	if (!c[2] || !c[3]) {
+		/* For two or three characters, skip whole words containing
+		 * none of them and no null byte. */
+		unsigned char c0 = c[0], c1 = c[1], c2 = c[2] ? c[2] : c0;
+#ifdef __GNUC__
+		typedef size_t __attribute__((__may_alias__)) word;
+		const word *w;
+		size_t k0 = ONES*c0, k1 = ONES*c1, k2 = ONES*c2;
+		for (; (uintptr_t)s % ALIGN; s++) {
+			unsigned char x = *s;
+			if (!x || x == c0 || x == c1 || x == c2) return s-a;
+		}
+		for (w = (const void *)s; !HASZERO(*w) && !HASZERO(*w^k0)
+		     && !HASZERO(*w^k1) && !HASZERO(*w^k2); w++);
+		s = (const void *)w;
+#endif
+		for (;; s++) {
+			unsigned char x = *s;
+			if (!x || x == c0 || x == c1 || x == c2) return s-a;
+		}
+	}
+
 	memset(byteset, 0, sizeof byteset);
 	for (; *c && BITOP(byteset, *(unsigned char *)c, |=); c++);
 	for (; *s && !BITOP(byteset, *(unsigned char *)s, &); s++);
@@ -1,17 +1,42 @@
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 
 #define BITOP(a,b,op) \
  ((a)[(size_t)(b)/(8*sizeof *(a))] op (size_t)1<<((size_t)(b)%(8*sizeof *(a))))
 
+#define ALIGN (sizeof(size_t))
+#define ONES ((size_t)-1/UCHAR_MAX)
+#define HIGHS (ONES * (UCHAR_MAX/2+1))
+#define NONZERO(x) ((((x) & ~HIGHS) + ~HIGHS | (x)) & HIGHS)
+
 size_t strspn(const char *s, const char *c)
 {
 	const char *a = s;
 	size_t byteset[32/sizeof(size_t)] = { 0 };
 
 	if (!c[0]) return 0;
-	if (!c[1]) {
-		for (; *s == *c; s++);
-		return s-a;
+	if (!c[1] || !c[2] || !c[3]) {
+		/* For up to three characters, skip whole words whose bytes
+		 * all match one of them; none of them is a null byte. */
+		unsigned char c0 = c[0], c1 = c[1] ? c[1] : c0,
+			c2 = c[1] && c[2] ? c[2] : c0;
+#ifdef __GNUC__
+		typedef size_t __attribute__((__may_alias__)) word;
+		const word *w;
+		size_t k0 = ONES*c0, k1 = ONES*c1, k2 = ONES*c2;
+		for (; (uintptr_t)s % ALIGN; s++) {
+			unsigned char x = *s;
+			if (x != c0 && x != c1 && x != c2) return s-a;
+		}
+		for (w = (const void *)s; !(NONZERO(*w^k0) & NONZERO(*w^k1)
+		     & NONZERO(*w^k2)); w++);
+		s = (const void *)w;
+#endif
+		for (;; s++) {
+			unsigned char x = *s;
+			if (x != c0 && x != c1 && x != c2) return s-a;
+		}
 	}
 
 	for (; *c && BITOP(byteset, *(unsigned char *)c, |=); c++);
@@ -1,5 +1,6 @@
 #include <time.h>
 #include <stdint.h>
+#include <sys/random.h>
 #include "pthread_impl.h"
 
 /* This assumes that a check for the
@@ -10,8 +11,10 @@ char *__randname(char *template)
 	struct timespec ts;
 	unsigned long r;
 
-	__clock_gettime(CLOCK_REALTIME, &ts);
-	r = ts.tv_sec + ts.tv_nsec + __pthread_self()->tid * 65537UL;
+	if (__syscall(SYS_getrandom, &r, sizeof r, GRND_NONBLOCK) != sizeof r) {
+		__clock_gettime(CLOCK_REALTIME, &ts);
+		r = ts.tv_sec + ts.tv_nsec + __pthread_self()->tid * 65537UL;
+	}
 	for (i=0; i<6; i++, r>>=5)
 		template[i] = 'A'+(r&15)+(r&16)*2;
 
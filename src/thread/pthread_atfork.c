@@ -1,12 +1,13 @@
 #include <pthread.h>
 #include <errno.h>
+#include <stdint.h>
 #include "libc.h"
 #include "lock.h"
 
 #define malloc __libc_malloc
 #define calloc undef
 #define realloc undef
-#define free undef
+#define free __libc_free
 
 static struct atfork_funcs {
 	void (*prepare)(void);
@@ -37,6 +38,27 @@ void __fork_handler(int who)
 	}
 }
 
+/* Remove the handlers any of whose functions lie in [start, start+len),
+ * which is about to be unmapped by dlclose. */
+void __pthread_atfork_unload(void *start, size_t len)
+{
+	struct atfork_funcs *p, *next;
+	uintptr_t a = (uintptr_t)start;
+	LOCK(lock);
+	for (p=funcs; p; p=next) {
+		next = p->next;
+		if ((uintptr_t)p->prepare-a >= len
+		 && (uintptr_t)p->parent-a >= len
+		 && (uintptr_t)p->child-a >= len)
+			continue;
+		if (p->prev) p->prev->next = next;
+		else funcs = next;
+		if (next) next->prev = p->prev;
+		free(p);
+	}
+	UNLOCK(lock);
+}
+
 int pthread_atfork(void (*prepare)(void), void (*parent)(void), void (*child)(void))
 {
 	struct atfork_funcs *new = malloc(sizeof *new);